@@ -0,0 +1,52 @@
+#!/bin/sh
+# include-cost.sh [compiler] [rev]
+#
+# measures what one translation unit pays for including kt-args.hpp:
+# the preprocessed line count and the mean time of a -fsyntax-only
+# compile over $RUNS runs (default 10). the working tree header is
+# compared against the header at <rev>, which defaults to the last
+# single-header version (the parent of the commit that dropped
+# boost/lexical_cast from it). extra flags, e.g. a boost include path,
+# can be passed in $CXXFLAGS.
+set -eu
+
+cxx=${1:-${CXX:-c++}}
+rev=${2:-}
+runs=${RUNS:-10}
+flags="-std=c++20 ${CXXFLAGS:-}"
+root=$(cd "$(dirname "$0")/.." && pwd)
+
+if [ -z "$rev" ]; then
+  rev=$(git -C "$root" log -S'boost/lexical_cast.hpp' --format=%H -1 -- kt-args.hpp)~1
+fi
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+mkdir "$tmp/before"
+for header in kt-args.hpp kt-type-name.hpp; do
+  git -C "$root" show "$rev:$header" > "$tmp/before/$header"
+done
+printf '#include "kt-args.hpp"\nint main() {}\n' > "$tmp/tu.cpp"
+
+now_ms() {
+  date +%s%N | cut -c1-13
+}
+measure() {
+  label=$1
+  include_dir=$2
+  # shellcheck disable=SC2086
+  lines=$("$cxx" $flags -I"$include_dir" -E "$tmp/tu.cpp" | wc -l)
+  start=$(now_ms)
+  i=0
+  while [ "$i" -lt "$runs" ]; do
+    # shellcheck disable=SC2086
+    "$cxx" $flags -I"$include_dir" -fsyntax-only "$tmp/tu.cpp"
+    i=$((i + 1))
+  done
+  end=$(now_ms)
+  printf '%-8s %8d lines %8d ms/TU\n' "$label" "$lines" $(((end - start) / runs))
+}
+
+echo "kt-args.hpp include cost ($cxx, $runs runs, before = $(git -C "$root" rev-parse --short "$rev"))"
+measure before "$tmp/before"
+measure after "$root"
@@ -0,0 +1,52 @@
+/* kt-args-convert.hpp
+
+MIT License
+
+Copyright (c) 2022 amberlily122
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef args_convert_hpp_20261019_101500_PST
+#define args_convert_hpp_20261019_101500_PST
+// the definition of detail::convert. kt-args.hpp only declares it, so
+// that boost/lexical_cast stays out of every includer; include this
+// header in the translation units that ref() a type kt-args.cpp does not
+// already instantiate (anything streamable with operator>>). with cmake,
+// link kt-args-convert rather than kt-args to get boost's include path.
+#include "kt-args.hpp"
+#include <boost/lexical_cast.hpp>
+#include <istream>
+namespace kt::args::detail {
+
+// only for types the primary template rejects, so has_convert<int> is
+// the same specialization whether or not this header is included
+template<typename _T>
+struct has_convert<_T, std::enable_if_t<not builtin_convert<_T>::value,
+                       std::void_t<decltype(std::declval<std::istream&>() >> std::declval<_T&>())>>>
+    : std::true_type
+  {};
+
+template<typename _T>
+auto convert(std::string_view _sv, _T& _out) -> bool
+  {
+    return boost::conversion::try_lexical_convert(_sv, _out);
+  }
+
+} /* namespace kt::args::detail */
+#endif//args_convert_hpp_20261019_101500_PST
@@ -2,12 +2,20 @@
 #include "kt-args.hpp"
 
 struct duck_info { int qty = 0; };
+enum class goose_mood { calm, honking, chasing };
+constexpr auto goose_moods = kt::args::choices<goose_mood>
+  ({ { "calm",    goose_mood::calm    }
+   , { "honking", goose_mood::honking }
+   , { "chasing", goose_mood::chasing }
+   });
 
 auto main(int _ac, char* _av[]) -> int
 try {
   using namespace std;
   using namespace kt;
   auto ducks = duck_info {};
+  auto goose = goose_mood::calm;
+  auto nap   = chrono::milliseconds {};
   variant<char, int, float, string_view> birds = 0;
   auto dump = [&](args::value_arg _v)
               {
@@ -31,7 +39,9 @@ try {
                   );
                 }
               };
-  args::parser()
+  auto cli = args::parser {};
+  cli
+    (args::positional { "FILE", {},                                                                                                       "Files to process      " })
     (args::opt { "",            [](args::value_arg _v)      { cout << "something random: " << _v.second << "\n"; }})
     (args::opt { "    --help",  args::help_opt(cout) } )
     (args::opt { "-d,--dog",    [](args::value_arg _v)      { cout << "the dog goes \"" << _v.second << "\"\n"; },                          "What does the dog say?"})
@@ -40,10 +50,21 @@ try {
     (args::opt { "-q,--duck",   args::ref(ducks.qty),                                                                                       "Duck qty              " })
     (args::opt { "-p       ",   dump,                                                                                                       "Display information   " })
     (args::opt { "-b,--bird" ,  args::variant_ref(birds),                                                                                   "Birdseed qty          " })
-    //(_ac, _av).halt_on("--dog")()
+    (args::opt { "-g,--goose",  args::choice(goose, goose_moods),                                                                           "Goose mood            " })
+    (args::opt { "-n,--nap",    args::ref(nap),                                                                                             "Cat nap length        " })
+    .exclusive({ "--cat", "--snail" })
+    .halt_on("--exec")
     .parse(_ac, _av)
     .send();
     ;
+  for(auto file : cli.positionals())
+  {
+    cout << "file: " << file << "\n";
+  }
+  for(auto arg : cli.tail())
+  {
+    cout << "passthrough: " << arg << "\n";
+  }
   return 0;
 }
 catch(const std::exception& _err)
@@ -0,0 +1,903 @@
+/* kt-args.cpp
+
+MIT License
+
+Copyright (c) 2022 amberlily122
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "kt-args-convert.hpp"
+#include <charconv>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+namespace kt::args {
+
+auto err_invalid_value(std::string_view _arg_name) -> std::runtime_error
+{
+  auto msg = std::stringstream {};
+  msg << "argument '" << _arg_name << "' does not accept a value";
+  return std::runtime_error { msg.str() };
+}
+auto err_invalid_arg(std::string_view _arg_name) -> std::runtime_error
+{
+  auto msg = std::stringstream {};
+  msg << "invalid argument '" << _arg_name << "'";
+  return std::runtime_error { msg.str() };
+}
+auto err_arg_required(std::string_view _arg_name) -> std::runtime_error
+{
+  auto msg = std::stringstream {};
+  msg << "argument '" << _arg_name << "' requires value";
+  return std::runtime_error { msg.str() };
+}
+auto err_positional_arity(std::string_view _name, size_t _count, size_t _min, size_t _max) -> std::runtime_error
+{
+  auto msg = std::stringstream {};
+  msg << "expected ";
+  if(_min == _max)          msg << _min;
+  else if(_count < _min)    msg << "at least " << _min;
+  else                      msg << "at most " << _max;
+  msg << " '" << _name << "' argument(s), got " << _count;
+  return std::runtime_error { msg.str() };
+}
+auto longest_name(const opt& _opt) -> std::string_view
+{
+  auto opt_name = std::string_view {"<<unknown>>"};
+  if(_opt.short_name().has_value())
+  {
+    opt_name = _opt.short_name().value(); 
+  }
+  else 
+  if(_opt.long_name().has_value())
+  {
+    opt_name = _opt.long_name().value();
+  }
+  return opt_name;
+}
+auto err_ref_conversion(const opt& _opt, std::string_view _sv, std::string_view _type) -> std::runtime_error
+{
+  auto opt_name = longest_name(_opt);
+  auto msg = std::stringstream {};
+  msg << "could not convert '" << _sv << "' to type " << _type << " for option '" << opt_name << "'";
+  return std::runtime_error { msg.str() };
+}
+auto err_invalid_choice(const opt& _opt, std::string_view _sv) -> std::runtime_error
+{
+  auto msg = std::stringstream {};
+  msg << "invalid value '" << _sv << "' for option '" << longest_name(_opt) << "', must be one of: ";
+  auto first = true;
+  for(const auto& name : _opt.choices())
+  {
+    msg << (first? "" : ", ") << name;
+    first = false;
+  }
+  return std::runtime_error { msg.str() };
+}
+auto err_unit_conversion(const opt& _opt, std::string_view _sv, std::string_view _what, std::string_view _why) -> std::runtime_error
+{
+  auto msg = std::stringstream {};
+  msg << "could not convert '" << _sv << "' to " << _what << " for option '" << longest_name(_opt) << "': " << _why;
+  return std::runtime_error { msg.str() };
+}
+
+template auto detail::convert(std::string_view, bool&)               -> bool;
+template auto detail::convert(std::string_view, char&)               -> bool;
+template auto detail::convert(std::string_view, signed char&)        -> bool;
+template auto detail::convert(std::string_view, unsigned char&)      -> bool;
+template auto detail::convert(std::string_view, short&)              -> bool;
+template auto detail::convert(std::string_view, unsigned short&)     -> bool;
+template auto detail::convert(std::string_view, int&)                -> bool;
+template auto detail::convert(std::string_view, unsigned int&)       -> bool;
+template auto detail::convert(std::string_view, long&)               -> bool;
+template auto detail::convert(std::string_view, unsigned long&)      -> bool;
+template auto detail::convert(std::string_view, long long&)          -> bool;
+template auto detail::convert(std::string_view, unsigned long long&) -> bool;
+template auto detail::convert(std::string_view, float&)              -> bool;
+template auto detail::convert(std::string_view, double&)             -> bool;
+template auto detail::convert(std::string_view, long double&)        -> bool;
+template auto detail::convert(std::string_view, std::string&)        -> bool;
+
+auto opt::send(const std::optional<value_type>& _value) const -> void
+{
+  using namespace std;
+  visit
+    ( [&](const auto& _send)
+      {
+        using sender_type = decay_t<decltype(_send)>;
+        if constexpr(is_same_v<sender_type, no_value_fn>)
+        {
+          if(_value.has_value())
+          {
+            throw err_invalid_value(longest_name(*this));
+          }
+          _send(*this);
+        }
+        else 
+        if constexpr(is_same_v<sender_type, value_fn>)
+        {
+          if(not _value.has_value())
+          {
+            throw err_arg_required(longest_name(*this));
+          }
+          _send(value_arg { *this, *_value });
+        }
+        else 
+        if constexpr(is_same_v<sender_type, opt_value_fn>)
+        {
+          _send(opt_value_arg { *this, (_value? &(*_value) : nullptr) });
+        }
+      }
+    , action()
+    );
+}
+
+
+namespace detail {
+  // a unit as a fraction of one second
+  struct time_unit { uint64_t num; uint64_t den; };
+
+  constexpr auto size_units = choices<uint64_t>
+    ({ { "",    1                     }, { "B",   1                     }
+     , { "k",   1000                  }, { "kB",  1000                  }
+     , { "K",   1000                  }, { "KB",  1000                  }
+     , { "Ki",  uint64_t { 1 } << 10  }, { "KiB", uint64_t { 1 } << 10  }
+     , { "M",   1000000               }, { "MB",  1000000               }
+     , { "Mi",  uint64_t { 1 } << 20  }, { "MiB", uint64_t { 1 } << 20  }
+     , { "G",   1000000000            }, { "GB",  1000000000            }
+     , { "Gi",  uint64_t { 1 } << 30  }, { "GiB", uint64_t { 1 } << 30  }
+     , { "T",   1000000000000         }, { "TB",  1000000000000         }
+     , { "Ti",  uint64_t { 1 } << 40  }, { "TiB", uint64_t { 1 } << 40  }
+     , { "P",   1000000000000000      }, { "PB",  1000000000000000      }
+     , { "Pi",  uint64_t { 1 } << 50  }, { "PiB", uint64_t { 1 } << 50  }
+     , { "E",   1000000000000000000   }, { "EB",  1000000000000000000   }
+     , { "Ei",  uint64_t { 1 } << 60  }, { "EiB", uint64_t { 1 } << 60  }
+     });
+  constexpr auto count_units = choices<uint64_t>
+    ({ { "",     1                     }
+     , { "k",    1000                  }, { "K",    1000                  }
+     , { "M",    1000000               }
+     , { "G",    1000000000            }
+     , { "T",    1000000000000         }
+     });
+  constexpr auto time_units = choices<time_unit>
+    ({ { "ns",  { 1,     1000000000 } }
+     , { "us",  { 1,     1000000    } }
+     , { "ms",  { 1,     1000       } }
+     , { "s",   { 1,     1          } }
+     , { "min", { 60,    1          } }
+     , { "h",   { 3600,  1          } }
+     , { "d",   { 86400, 1          } }
+     });
+
+  constexpr auto checked_mul(uint64_t _a, uint64_t _b, uint64_t& _out) -> bool
+    {
+      if(_a != 0 && _b > std::numeric_limits<uint64_t>::max() / _a) return false;
+      _out = _a * _b;
+      return true;
+    }
+  // split "512MiB" into 512 and "MiB"
+  auto split_number(std::string_view _sv, uint64_t& _n, std::string_view& _suffix,
+                           std::optional<uint64_t> _default = std::nullopt) -> std::string_view
+    {
+      auto [end, ec] = std::from_chars(_sv.data(), _sv.data() + _sv.size(), _n);
+      if(ec == std::errc::result_out_of_range) return "value out of range";
+      if(ec != std::errc {})
+      {
+        if(not _default.has_value() || _sv.empty()) return "invalid number";
+        _n   = *_default;
+        end  = _sv.data();
+      }
+      // otherwise ".5s" of "1.5s" would be read as the unit
+      if(end != _sv.data() + _sv.size() && *end == '.') return "fractional values are not supported";
+      _suffix = _sv.substr(end - _sv.data());
+      return "";
+    }
+  template<size_t _N>
+  auto parse_scaled(std::string_view _sv, const choice_table<uint64_t, _N>& _units, uint64_t& _out) -> std::string_view
+    {
+      auto n      = uint64_t { 0 };
+      auto suffix = std::string_view {};
+      if(auto why = split_number(_sv, n, suffix); not why.empty()) return why;
+      const auto* unit = _units.find(suffix);
+      if(unit == nullptr) return "unknown unit";
+      if(not checked_mul(n, unit->second, _out)) return "value out of range";
+      return "";
+    }
+  auto parse_size(std::string_view _sv, uint64_t& _out) -> std::string_view
+    {
+      return parse_scaled(_sv, size_units, _out);
+    }
+  auto parse_ticks(std::string_view _sv, uint64_t _num, uint64_t _den, std::optional<uint64_t> _default,
+                   uint64_t& _scaled, uint64_t& _den_out) -> std::string_view
+    {
+      auto n      = uint64_t { 0 };
+      auto suffix = std::string_view {};
+      if(auto why = split_number(_sv, n, suffix, _default); not why.empty()) return why;
+      if(suffix.empty()) return "missing unit (ns, us, ms, s, min, h or d)";
+      const auto* found = time_units.find(suffix);
+      if(found == nullptr) return "unknown unit";
+      // ticks = n * (unit seconds) / (tick seconds), reduced first so the
+      // intermediate products stay small
+      auto unit = found->second;
+      auto g1   = std::gcd(unit.num, _num);
+      auto g2   = std::gcd(unit.den, _den);
+      auto num  = uint64_t { 0 };
+      if(not checked_mul(unit.num / g1, _den / g2, num)
+      || not checked_mul(unit.den / g2, _num / g1, _den_out)
+      || not checked_mul(n, num, _scaled))
+      {
+        return "value out of range";
+      }
+      return "";
+    }
+  auto parse_rate(std::string_view _sv, rate& _out) -> std::string_view
+    {
+      auto slash = std::min(_sv.find('/'), _sv.size());
+      auto result = rate {};
+      if(auto why = parse_scaled(_sv.substr(0, slash), count_units, result.count); not why.empty()) return why;
+      if(slash != _sv.size())
+      {
+        if(auto why = parse_duration(_sv.substr(slash + 1), result.per, 1); not why.empty()) return why;
+        if(result.per.count() == 0) return "interval must not be zero";
+      }
+      _out = result;
+      return "";
+    }
+} /* namespace detail */
+
+auto constraint_error::describe(const violation_store& _violations) -> std::string
+{
+  auto msg = std::stringstream {};
+  auto quoted = [&](auto _first, auto _last, std::string_view _conj)
+    {
+      for(auto iter = _first; iter != _last; ++iter)
+      {
+        if(iter != _first) msg << (iter + 1 == _last? _conj : ", ");
+        msg << "'" << *iter << "'";
+      }
+    };
+  auto first = true;
+  for(const auto& [kind, opts] : _violations)
+  {
+    msg << (first? "" : "\n");
+    first = false;
+    switch(kind)
+    {
+      case violation_kind::missing_required:
+        msg << "missing required argument" << (opts.size() > 1? "s " : " ");
+        quoted(opts.begin(), opts.end(), " and ");
+        break;
+      case violation_kind::mutually_exclusive:
+        msg << "arguments ";
+        quoted(opts.begin(), opts.end(), " and ");
+        msg << " are mutually exclusive";
+        break;
+      case violation_kind::missing_dependency:
+        msg << "argument '" << opts.front() << "' requires ";
+        quoted(opts.begin() + 1, opts.end(), " and ");
+        break;
+    }
+  }
+  return msg.str();
+}
+
+namespace detail {
+  // fixed-width fields of a parser snapshot, in native byte order; a
+  // snapshot is meant to be handed to processes on the same machine
+  template<typename _T>
+  auto put(std::string& _buf, _T _value) -> void
+    {
+      _buf.append(reinterpret_cast<const char*>(&_value), sizeof(_value));
+    }
+  auto put(std::string& _buf, std::string_view _sv) -> void
+    {
+      put(_buf, static_cast<uint32_t>(_sv.size()));
+      _buf.append(_sv);
+      _buf.push_back('\0');
+    }
+  // bounds-checked reader over a snapshot; any short read fails the
+  // reader and every later read
+  class snapshot_reader
+  {
+  public:
+    explicit snapshot_reader(std::string_view _buf) : buf_(_buf) {}
+    template<typename _T>
+    auto get(_T& _value) -> bool
+      {
+        if(not ok_ || buf_.size() < sizeof(_value)) return ok_ = false;
+        std::memcpy(&_value, buf_.data(), sizeof(_value));
+        buf_.remove_prefix(sizeof(_value));
+        return true;
+      }
+    // a string written by put(); the view includes the trailing '\0'
+    // so the caller may treat its data() as a c string
+    auto get(std::string_view& _value) -> bool
+      {
+        auto size = uint32_t { 0 };
+        if(not get(size) || buf_.size() <= size || buf_[size] != '\0') return ok_ = false;
+        _value = buf_.substr(0, size);
+        buf_.remove_prefix(size + 1);
+        return true;
+      }
+    auto done() const -> bool { return ok_ && buf_.empty(); }
+    // an upper bound on how many records of at least _min_size bytes
+    // are left, for checking counts read from the blob
+    auto fits(uint32_t _count, size_t _min_size) const -> bool { return _count <= buf_.size() / _min_size; }
+  private:
+    std::string_view  buf_;
+    bool              ok_ = true;
+  };
+} /* namespace detail */
+
+auto parser::send()    const -> void
+{
+  if(not stop_parsing_)
+  {
+    // values carried by a loaded snapshot are written back in place of
+    // their opt's last match, the one that decided the value, so the
+    // other senders run against the same state as after parse()
+    auto stored = stored_values_.begin();
+    for(size_t pos = 0; pos < matches_.size(); ++pos)
+    {
+      const auto& [opt, value] = matches_[pos];
+      if(stored != stored_values_.end() && stored->first == pos)
+      {
+        opt.codec()->restore(stored->second.data());
+        ++stored;
+      }
+      else
+      {
+        opt.send(value);
+      }
+    }
+    sent_ = true;
+  }
+}
+
+auto parser::parse(int _ac, char* _av[]) -> parser&
+{
+  stop_parsing_ = false;
+  using namespace std;
+  matches_.clear();
+  positionals_.clear();
+  seen_.reset(opts_.size());
+  restored_.reset(opts_.size());
+  stored_values_.clear();
+  sent_         = false;
+  auto args     = arg_span { (const char**)_av, (size_t)_ac };
+  auto arg_iter = args.begin();
+  auto argv     = std::span<char*> { _av, (size_t)_ac };
+  tail_         = argv.subspan(argv.size());
+  halted_       = false;
+  argc_         = argv.size();
+  // stop at _iter; the tail is handed back untouched
+  auto halt_at  = [&](auto _iter)
+    {
+      tail_   = argv.subspan(_iter - args.begin());
+      halted_ = true;
+    };
+  auto is_halt_name = [&](auto arg)
+    {
+      return std::find(halt_names_.begin(), halt_names_.end(), arg) != halt_names_.end();
+    };
+  auto parse_short = 
+    [&](auto arg) -> void
+    {
+      auto compare = string { "--" };
+      bool stop_parsing_short_arg = false;
+      for(size_t arg_idx = 1; arg_idx < arg.size(); ++arg_idx)
+      {
+        if(stop_parsing_ || stop_parsing_short_arg) break;
+        auto extract_short_value =
+          [&](bool _attached_only = false) -> optional<string_view>
+          {
+            auto value = std::optional<string_view> {};
+            // try to extract the arg value from the current
+            // arg
+            auto next_idx = arg_idx + 1;
+            // if we have more short opt chars available...
+            if(next_idx < arg.size())
+            {
+              // ...extract the value from it
+              auto value_tmp = arg.substr(next_idx);   
+              // skip the first '=' char, if it exists
+              if(not value_tmp.empty() && value_tmp[0] == '=') value_tmp.remove_prefix(1);
+              value = value_tmp;
+              // cause the short arg iterator loop to exit
+              stop_parsing_short_arg = true;
+            }
+            else
+            {
+              // throw err_invalid_value();
+              // peek at the next arg
+              auto next_arg_iter = arg_iter + 1;  
+              auto no_more_args = next_arg_iter == args.end();
+              if(no_more_args || _attached_only)
+              {
+                return std::nullopt;
+              }
+              auto next_arg = string_view { *next_arg_iter };
+              auto arg_is_value = (not arg_is_short(next_arg))
+                              and (not opt_is_long(next_arg));
+              if(arg_is_value)
+              {
+                value = next_arg;
+                arg_iter = next_arg_iter;
+              }
+              else
+              {
+                return std::nullopt;
+              }
+            }
+            return value;
+          };
+        compare[1] = arg[arg_idx];
+        auto found_match = false;
+        for(const auto& opt : opts_)
+        {
+          const auto& opt_name = opt.short_name();
+          if(opt_name.has_value() && *opt_name == compare)
+          {
+            found_match = true;
+            const auto& opt_action = opt.action();
+            std::visit
+              ( [&](auto&& _send)
+                {
+                  using fn_type = decay_t<decltype(_send)>;
+                  if constexpr(sender_has_value<fn_type>())
+                  {
+                    auto value = extract_short_value();
+                    //if(not value.has_value())
+                    //{
+                    //  throw err_arg_required(compare);
+                    //}
+                    add_match(opt, value);
+                  }
+                  else if constexpr(sender_has_opt_value<fn_type>())
+                  {
+                    // when halting on a positional, the next token may be
+                    // the command to hand on, not this opt's value
+                    auto value = extract_short_value(halt_on_positional_);
+                    //_send(opt_value_arg(opt, value? &(*value) : nullptr));
+                    add_match(opt, value);
+                  }
+                  else if constexpr(sender_is_meta<fn_type>())
+                  {
+                    auto meta     = meta_arg   { opt, *this };
+                    _send(meta);
+                  }
+                  else
+                  {
+                    auto next_idx = arg_idx + 1;
+                    if(next_idx < arg.size() && arg[next_idx] == '=')
+                    {
+                      throw err_invalid_value(compare);
+                    }
+                    //_send(opt);
+                    add_match(opt, nullopt);
+                  }
+                }
+              , opt_action
+              );
+
+          }
+        }
+        if(not found_match)
+        {
+          throw err_invalid_arg(compare);
+        }
+      }
+    };
+  auto parse_long  = [&](auto arg) 
+    {
+      auto arg_name     = string_view {};
+      auto arg_value    = optional<string_view> {};
+      auto delim_pos    = min(arg.find('='), arg.size());
+      auto delim_found  = delim_pos != arg.size();
+      if(not delim_found)
+      {
+        arg_name = arg;
+      }
+      else
+      {
+        auto value_start = std::min(delim_pos + 1, arg.size());
+        arg_name  = arg.substr(0, delim_pos);
+        arg_value = arg.substr(value_start);
+      }
+      auto extract_long_value = [&](bool _attached_only = false) -> std::optional<value_type>
+        {
+          if(arg_value.has_value()) return arg_value;
+          auto next_arg_iter = arg_iter + 1;
+          if(next_arg_iter == args.end() || _attached_only)
+          {
+            return nullopt;
+          }
+          auto next_arg = string_view { *next_arg_iter };
+          if(arg_is_opt(next_arg))
+          {
+            return nullopt;
+          }
+          arg_iter = next_arg_iter;
+          return next_arg;
+        };
+      auto found_match = false;
+      for(auto& opt : opts_)
+      {
+        auto opt_name = opt.long_name();
+        if(opt_name.has_value() && *opt_name == arg_name)
+        {
+          found_match = true;
+          std::visit
+            ( [&](auto&& _send)
+              {
+                using fn_type = decay_t<decltype(_send)>;
+                if constexpr(sender_has_value<fn_type>())
+                {
+                  auto value = extract_long_value();        
+                  //if(not value.has_value())
+                  //{
+                  //  throw err_arg_required(*opt_name);
+                  //}
+                  add_match(opt, value);
+                }
+                else if constexpr(sender_has_opt_value<fn_type>())
+                {
+                  auto value = extract_long_value(halt_on_positional_);
+                  add_match(opt, value);
+                }
+                else if constexpr(sender_is_meta<fn_type>())
+                {
+                  auto meta     = meta_arg   { opt, *this };
+                  _send(meta);
+                }
+                else
+                {
+                  //if(arg_value.has_value())
+                  //{
+                  //  throw err_invalid_value(arg_name);
+                  //}
+                  add_match(opt, nullopt);
+                }
+              }
+            , opt.action()
+            );
+        }
+      }
+      if(not found_match)
+      {
+        throw err_invalid_arg(arg_name);
+      }
+    };
+  auto parse_positional = [&](auto arg)
+    {
+      positionals_.append(&*arg_iter, 1);
+      if(not has_positional_opt_) return;
+      for(const auto& opt : opts_)
+      {
+        if(opt.is_positional())
+        {
+          add_match(opt, arg);
+        }
+      }
+    };
+  auto exec_name = *arg_iter;
+  ++arg_iter;
+  while(arg_iter != args.end())
+  {
+    if(stop_parsing_) break;
+    auto arg = string_view { *arg_iter };
+    if(arg == "--" && halt_on_positional_)
+    {
+      halt_at(arg_iter + 1);
+      break;
+    }
+    else if(arg_is_opt(arg) && is_halt_name(arg))
+    {
+      halt_at(arg_iter + 1);
+      break;
+    }
+    else if(arg == "--")
+    {
+      // everything after the terminator is positional
+      ++arg_iter;
+      if(has_positional_opt_)
+      {
+        for(; arg_iter != args.end(); ++arg_iter)
+        {
+          parse_positional(string_view { *arg_iter });
+        }
+      }
+      else
+      {
+        positionals_.append(args.data() + (arg_iter - args.begin()), args.end() - arg_iter);
+        arg_iter = args.end();
+      }
+      break;
+    }
+    else if(arg_is_short(arg))
+    {
+      parse_short(arg);
+    }
+    else if(arg_is_long(arg))
+    {
+      parse_long(arg);
+    }
+    else if(halt_on_positional_)
+    {
+      halt_at(arg_iter);
+      break;
+    }
+    else
+    {
+      parse_positional(arg);
+    }
+    ++arg_iter;
+  }
+  if(positional_.has_value() && not stop_parsing_)
+  {
+    const auto& [min, max] = positional_->range();
+    auto count = positionals_.size();
+    if(count < min || count > max)
+    {
+      throw err_positional_arity(positional_->name(), count, min, max);
+    }
+  }
+  if(not stop_parsing_)
+  {
+    if(auto violations = check(); not violations.empty())
+    {
+      throw constraint_error { std::move(violations) };
+    }
+  }
+  return *this;
+}
+
+auto parser::spec_hash() const -> uint64_t
+{
+  auto h = uint64_t { 0 };
+  for(const auto& opt : opts_)
+  {
+    h = detail::hash(opt.short_name().value_or(""), h);
+    h = detail::hash(opt.long_name().value_or(""), h ^ opt.action().index());
+    h = detail::hash("", h ^ (opt.codec().has_value()? opt.codec()->id : 0));
+    for(auto name : opt.choices())
+    {
+      h = detail::hash(name, h ^ 2);
+    }
+  }
+  if(positional_.has_value())
+  {
+    const auto& [min, max] = positional_->range();
+    h = detail::hash(positional_->name(), h ^ min);
+    h = detail::hash("", h ^ max);
+  }
+  // the constraints and halt settings change what a parse accepts, so
+  // a snapshot taken without them is not valid with them
+  auto mix_set = [&](std::string_view _tag, const opt_set& _set)
+    {
+      h = detail::hash(_tag, h);
+      _set.for_each([&](size_t _idx) { h = detail::hash("", h ^ _idx); });
+    };
+  mix_set("required", required_);
+  for(const auto& group : exclusive_)
+  {
+    mix_set("exclusive", group);
+  }
+  for(const auto& [idx, needs] : depends_)
+  {
+    mix_set("depends", needs);
+    h = detail::hash("", h ^ idx);
+  }
+  for(auto name : halt_names_)
+  {
+    h = detail::hash(name, h ^ 1);
+  }
+  h = detail::hash("halt_on_positional", h ^ halt_on_positional_);
+  return h;
+}
+
+auto parser::snapshot() const -> std::string
+{
+  auto buf = std::string {};
+  detail::put(buf, snapshot_magic);
+  detail::put(buf, snapshot_version);
+  detail::put(buf, spec_hash());
+  detail::put(buf, static_cast<uint32_t>(stop_parsing_));
+  // the tail itself is not stored, only where it starts; the child
+  // rebuilds it from its own argv
+  detail::put(buf, static_cast<uint32_t>(halted_));
+  detail::put(buf, static_cast<uint32_t>(argc_));
+  detail::put(buf, static_cast<uint32_t>(argc_ - tail_.size()));
+  detail::put(buf, static_cast<uint32_t>(matches_.size()));
+  for(const auto& [opt, value] : matches_)
+  {
+    detail::put(buf, static_cast<uint32_t>(&opt - opts_.data()));
+    detail::put(buf, static_cast<uint32_t>(value.has_value()));
+    if(value.has_value()) detail::put(buf, *value);
+  }
+  detail::put(buf, static_cast<uint32_t>(positionals_.size()));
+  for(auto arg : positionals_)
+  {
+    detail::put(buf, arg);
+  }
+  // once send() has run, the converted values of the opts that have a
+  // codec are stored too
+  auto stored = std::vector<size_t> {};
+  if(sent_)
+  {
+    seen_.for_each([&](size_t _idx) { if(opts_[_idx].codec().has_value()) stored.emplace_back(_idx); });
+  }
+  detail::put(buf, static_cast<uint32_t>(stored.size()));
+  for(auto idx : stored)
+  {
+    auto bytes = std::string {};
+    opts_[idx].codec()->save(bytes);
+    detail::put(buf, static_cast<uint32_t>(idx));
+    detail::put(buf, std::string_view { bytes });
+  }
+  return buf;
+}
+
+auto parser::load(std::string_view _blob, int _ac, char* _av[]) -> bool
+{
+  matches_.clear();
+  positionals_.clear();
+  seen_.reset(opts_.size());
+  restored_.reset(opts_.size());
+  stored_values_.clear();
+  sent_               = false;
+  tail_               = {};
+  halted_             = false;
+  argc_               = 0;
+  stop_parsing_       = false;
+  snapshot_buf_.assign(_blob);
+  snapshot_args_.clear();
+  auto reader         = detail::snapshot_reader { snapshot_buf_ };
+  auto magic          = uint32_t { 0 };
+  auto version        = uint32_t { 0 };
+  auto hash           = uint64_t { 0 };
+  auto stopped        = uint32_t { 0 };
+  auto halted         = uint32_t { 0 };
+  auto argc           = uint32_t { 0 };
+  auto halt_offset    = uint32_t { 0 };
+  auto match_count    = uint32_t { 0 };
+  auto arg_count      = uint32_t { 0 };
+  auto value_count    = uint32_t { 0 };
+  auto fail = [&]
+    {
+      matches_.clear();
+      positionals_.clear();
+      seen_.reset(opts_.size());
+      restored_.reset(opts_.size());
+      stored_values_.clear();
+      stop_parsing_ = false;
+      return false;
+    };
+  if(not reader.get(magic)    || magic   != snapshot_magic
+  || not reader.get(version)  || version != snapshot_version
+  || not reader.get(hash)     || hash    != spec_hash()
+  || not reader.get(stopped)  || not reader.get(halted)
+  || not reader.get(argc)     || not reader.get(halt_offset)
+  || not reader.get(match_count))
+  {
+    return fail();
+  }
+  // each match is at least its opt index and value flag
+  if(not reader.fits(match_count, 2 * sizeof(uint32_t))) return fail();
+  // a halted parse needs the same argv to hand back the same tail
+  if(halted && (_av == nullptr || argc != static_cast<uint32_t>(_ac) || halt_offset > argc))
+  {
+    return fail();
+  }
+  for(uint32_t i = 0; i < match_count; ++i)
+  {
+    auto idx        = uint32_t { 0 };
+    auto has_value  = uint32_t { 0 };
+    auto value      = std::string_view {};
+    if(not reader.get(idx) || idx >= opts_.size() || not reader.get(has_value)) return fail();
+    if(has_value && not reader.get(value)) return fail();
+    add_match(opts_[idx], has_value? std::optional<value_type> { value } : std::nullopt);
+  }
+  // each positional is at least its length and terminator
+  if(not reader.get(arg_count) || not reader.fits(arg_count, sizeof(uint32_t) + 1)) return fail();
+  snapshot_args_.reserve(arg_count);
+  for(uint32_t i = 0; i < arg_count; ++i)
+  {
+    auto arg = std::string_view {};
+    if(not reader.get(arg)) return fail();
+    snapshot_args_.emplace_back(arg.data());
+  }
+  // each stored value is at least its opt index, length and terminator
+  if(not reader.get(value_count) || not reader.fits(value_count, 2 * sizeof(uint32_t) + 1)) return fail();
+  for(uint32_t i = 0; i < value_count; ++i)
+  {
+    auto idx    = uint32_t { 0 };
+    auto bytes  = std::string_view {};
+    if(not reader.get(idx) || idx >= opts_.size() || not seen_.test(idx) || restored_.test(idx)
+    || not reader.get(bytes))
+    {
+      return fail();
+    }
+    const auto& codec = opts_[idx].codec();
+    if(not codec.has_value() || bytes.size() != codec->size) return fail();
+    auto last = std::find_if(matches_.rbegin(), matches_.rend(),
+                             [&](const auto& _m) { return &_m.first == &opts_[idx]; });
+    if(last == matches_.rend()) return fail();
+    stored_values_.emplace_back(matches_.rend() - last - 1, bytes);
+    restored_.set(idx);
+  }
+  std::sort(stored_values_.begin(), stored_values_.end(),
+            [](const auto& _a, const auto& _b) { return _a.first < _b.first; });
+  if(not reader.done()) return fail();
+  positionals_.append(snapshot_args_.data(), snapshot_args_.size());
+  stop_parsing_ = stopped != 0;
+  if(not stop_parsing_ && not check().empty()) return fail();
+  if(halted)
+  {
+    auto argv = std::span<char*> { _av, static_cast<size_t>(_ac) };
+    tail_   = argv.subspan(halt_offset);
+    halted_ = true;
+    argc_   = argv.size();
+  }
+  return true;
+}
+
+auto parser::check() const -> violation_store
+{
+  auto result = violation_store {};
+  auto names_of = [&](const opt_set& _set, bool _seen, std::vector<std::string_view>& _out)
+    {
+      _set.for_each([&](size_t _idx) { if(seen_.test(_idx) == _seen) _out.emplace_back(longest_name(opts_[_idx])); });
+    };
+  if(not required_.subset_of(seen_))
+  {
+    auto& v = result.emplace_back(violation { violation_kind::missing_required, {} });
+    names_of(required_, false, v.opts);
+  }
+  for(const auto& group : exclusive_)
+  {
+    if(group.intersect_count(seen_) > 1)
+    {
+      auto& v = result.emplace_back(violation { violation_kind::mutually_exclusive, {} });
+      names_of(group, true, v.opts);
+    }
+  }
+  for(const auto& [idx, needs] : depends_)
+  {
+    if(seen_.test(idx) && not needs.subset_of(seen_))
+    {
+      auto& v = result.emplace_back(violation { violation_kind::missing_dependency, { longest_name(opts_[idx]) } });
+      names_of(needs, false, v.opts);
+    }
+  }
+  return result;
+}
+
+auto parser::index_of(std::string_view _name) const -> size_t
+{
+  for(size_t idx = 0; idx < opts_.size(); ++idx)
+  {
+    const auto& opt = opts_[idx];
+    if(opt.short_name() == _name || opt.long_name() == _name) return idx;
+  }
+  throw std::logic_error { "constraint names an unknown option '" + std::string { _name } + "'" };
+}
+
+} /* namespace kt::args */
@@ -25,13 +25,26 @@ SOFTWARE.
 #ifndef args_hpp_20221122_134427_PST
 #define args_hpp_20221122_134427_PST
 #include "kt-type-name.hpp"
-#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <optional>
 #include <span>
-#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <variant>
 #include <vector>
-#include <map>
 namespace kt::args {
   
 template<typename _T>
@@ -48,7 +61,7 @@ auto type_name() -> std::string_view
     return tn;
   }
 }
-auto arg_is_long(std::string_view _s)
+constexpr auto arg_is_long(std::string_view _s)
   {
     switch(_s.size())
     {
@@ -57,7 +70,7 @@ auto arg_is_long(std::string_view _s)
       default:  return _s[0] == '-' && _s[1] == '-';
     }
   };
-auto arg_is_short(std::string_view _s)
+constexpr auto arg_is_short(std::string_view _s)
   {
     switch(_s.size())
     {
@@ -66,39 +79,22 @@ auto arg_is_short(std::string_view _s)
       default:  return _s[0] == '-' && _s[1] != '-';
     }
   };
-auto arg_is_opt(std::string_view _s)
+constexpr auto arg_is_opt(std::string_view _s)
   {
     return not _s.empty() && _s[0] == '-';
   };
-auto opt_is_long(std::string_view _s)
+constexpr auto opt_is_long(std::string_view _s)
   {
     return arg_is_long(_s);
   };
-auto opt_is_short(std::string_view _s)
+constexpr auto opt_is_short(std::string_view _s)
   {
     return _s.size() == 2 && arg_is_short(_s);
   };
-template<typename _T>
-auto err_invalid_value(_T&& _arg_name)
-  {
-    auto msg = std::stringstream {};
-    msg << "argument '" << _arg_name << "' does not accept a value";
-    return std::runtime_error { msg.str() };
-  };
-template<typename _T>
-auto err_invalid_arg(_T&& _arg_name)
-  {
-    auto msg = std::stringstream {};
-    msg << "invalid argument '" << _arg_name << "'";
-    return std::runtime_error { msg.str() };
-  };
-template<typename _T>
-auto err_arg_required(_T&& _arg_name)
-  {
-    auto msg = std::stringstream {};
-    msg << "argument '" << _arg_name << "' requires value";
-    return std::runtime_error { msg.str() };
-  };
+auto err_invalid_value(std::string_view _arg_name) -> std::runtime_error;
+auto err_invalid_arg(std::string_view _arg_name) -> std::runtime_error;
+auto err_arg_required(std::string_view _arg_name) -> std::runtime_error;
+auto err_positional_arity(std::string_view _name, size_t _count, size_t _min, size_t _max) -> std::runtime_error;
 class opt;
 
 auto longest_name(const opt& _opt) -> std::string_view;
@@ -112,11 +108,55 @@ using opt_value_arg = std::pair<const opt&, const value_type*>;
 using opt_store     = std::vector<opt>;
 using match_data    = std::pair<const opt&, std::optional<value_type>>; 
 using match_store   = std::vector<match_data>;
+using halt_store    = std::vector<std::string_view>;
 using meta_arg      = std::pair<const opt&, parser&>;
+using arg_span      = std::span<const char*>;
 
 template<typename OS>
 class help_opt;
 
+template<typename _E, size_t _N>
+class choice_ref;
+
+using choice_names  = std::vector<std::string_view>;
+
+namespace detail {
+  // fnv-1a with a seed, plus a final mix so the low bits are usable
+  constexpr auto hash(std::string_view _s, uint64_t _seed) -> uint64_t
+    {
+      auto h = uint64_t { 0xcbf29ce484222325 } ^ (_seed * 0x9e3779b97f4a7c15);
+      for(auto c : _s)
+      {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3;
+      }
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccd;
+      h ^= h >> 33;
+      return h;
+    }
+} /* namespace detail */
+
+// lets parser::snapshot() carry the value a sender converted: save
+// appends the bound variable's bytes and restore writes size of them
+// back, so a loaded parser need not convert the argument again. id
+// names the value's type (and a choice's table), so a parser binding
+// the opt to something else does not share a spec hash.
+struct value_codec
+{
+  size_t                                size = 0;
+  uint64_t                              id   = 0;
+  std::function<void(std::string&)>     save;
+  std::function<void(const char*)>      restore;
+};
+// a sender together with the codec for the variable it writes
+template<typename _FN>
+struct stored_sender
+{
+  _FN         sender;
+  value_codec codec;
+};
+
 class opt
 {
   using name_type     = std::string_view;
@@ -133,6 +173,19 @@ public:
   opt(name_type _n, help_opt<_OS> _h, desc_type _d = "")
       : opt(name_pair_from(_n), _h.sender(), _d)
     {}
+  template<typename _E, size_t _N>
+  opt(name_type _n, choice_ref<_E, _N> _c, desc_type _d = "")
+      : opt(name_pair_from(_n), _c.sender(), _d)
+    {
+      choices_ = _c.names();
+      codec_   = _c.codec();
+    }
+  template<typename _FN>
+  opt(name_type _n, stored_sender<_FN> _s, desc_type _d = "")
+      : opt(name_pair_from(_n), std::move(_s.sender), _d)
+    {
+      codec_ = std::move(_s.codec);
+    }
   opt(name_type _n, sender_fn _fn, desc_type _d = "")
       : opt(name_pair_from(_n), _fn, _d)
     {}
@@ -174,40 +227,12 @@ public:
   auto action()     const -> const sender_fn&         { return sender_; }
 
   auto is_positional() const -> bool { return not short_name().has_value() && not long_name().has_value(); }
-  auto send(const std::optional<value_type>& _value) const -> void
-    {
-      using namespace std;
-      visit
-        ( [&](const auto& _send)
-          {
-            using sender_type = decay_t<decltype(_send)>;
-            if constexpr(is_same_v<sender_type, no_value_fn>)
-            {
-              if(_value.has_value())
-              {
-                throw err_invalid_value(longest_name(*this));
-              }
-              _send(*this);
-            }
-            else 
-            if constexpr(is_same_v<sender_type, value_fn>)
-            {
-              if(not _value.has_value())
-              {
-                throw err_arg_required(longest_name(*this));
-              }
-              _send(value_arg { *this, *_value });
-            }
-            else 
-            if constexpr(is_same_v<sender_type, opt_value_fn>)
-            {
-              _send(opt_value_arg { *this, (_value? &(*_value) : nullptr) });
-            }
-          }
-        , action()
-        );
-    }
+  auto send(const std::optional<value_type>& _value) const -> void;
   auto desc() const -> const desc_type& { return desc_; }
+  // the accepted values of a choice opt, in table order; empty otherwise
+  auto choices() const -> const choice_names& { return choices_; }
+  // how the converted value is stored in a snapshot, if it can be
+  auto codec() const -> const std::optional<value_codec>& { return codec_; }
 private:
   opt(name_pair _ns, sender_fn _fn, desc_type _d)
       : short_name_ (std::move(_ns.first))
@@ -219,62 +244,133 @@ private:
   std::optional<name_type>  long_name_;
   sender_fn                 sender_;
   desc_type                 desc_;
+  choice_names              choices_;
+  std::optional<value_codec> codec_;
 };
 
+auto err_ref_conversion(const opt& _opt, std::string_view _sv, std::string_view _type) -> std::runtime_error;
+auto err_invalid_choice(const opt& _opt, std::string_view _sv) -> std::runtime_error;
+namespace detail {
+  // convert _sv to a _T, returning false if it is not a valid _T. this
+  // is only declared here: kt-args.cpp instantiates it for the builtin
+  // arithmetic types and std::string, and other types need
+  // kt-args-convert.hpp included wherever they are ref()'d.
+  template<typename _T>
+  auto convert(std::string_view _sv, _T& _out) -> bool;
+
+  extern template auto convert(std::string_view, bool&)               -> bool;
+  extern template auto convert(std::string_view, char&)               -> bool;
+  extern template auto convert(std::string_view, signed char&)        -> bool;
+  extern template auto convert(std::string_view, unsigned char&)      -> bool;
+  extern template auto convert(std::string_view, short&)              -> bool;
+  extern template auto convert(std::string_view, unsigned short&)     -> bool;
+  extern template auto convert(std::string_view, int&)                -> bool;
+  extern template auto convert(std::string_view, unsigned int&)       -> bool;
+  extern template auto convert(std::string_view, long&)               -> bool;
+  extern template auto convert(std::string_view, unsigned long&)      -> bool;
+  extern template auto convert(std::string_view, long long&)          -> bool;
+  extern template auto convert(std::string_view, unsigned long long&) -> bool;
+  extern template auto convert(std::string_view, float&)              -> bool;
+  extern template auto convert(std::string_view, double&)             -> bool;
+  extern template auto convert(std::string_view, long double&)        -> bool;
+  extern template auto convert(std::string_view, std::string&)        -> bool;
 
-auto longest_name(const opt& _opt) -> std::string_view
-{
-  auto opt_name = std::string_view {"<<unknown>>"};
-  if(_opt.short_name().has_value())
-  {
-    opt_name = _opt.short_name().value(); 
-  }
-  else 
-  if(_opt.long_name().has_value())
-  {
-    opt_name = _opt.long_name().value();
-  }
-  return opt_name;
-}
-template<typename _T>
-auto err_ref_conversion(const opt& _opt, std::string_view _sv)
-  {
-    auto opt_name = longest_name(_opt);
-    auto msg = std::stringstream {};
-    msg << "could not convert '" << _sv << "' to type " << type_name<_T>() << " for option '" << opt_name << "'";
-    return std::runtime_error { msg.str() };
-  }
+  // the types above, which convert<_T> is instantiated for in kt-args.cpp
+  template<typename _T>
+  struct builtin_convert
+      : std::bool_constant<( std::is_same_v<_T, bool>
+                          || std::is_same_v<_T, char>
+                          || std::is_same_v<_T, signed char>
+                          || std::is_same_v<_T, unsigned char>
+                          || std::is_same_v<_T, short>
+                          || std::is_same_v<_T, unsigned short>
+                          || std::is_same_v<_T, int>
+                          || std::is_same_v<_T, unsigned int>
+                          || std::is_same_v<_T, long>
+                          || std::is_same_v<_T, unsigned long>
+                          || std::is_same_v<_T, long long>
+                          || std::is_same_v<_T, unsigned long long>
+                          || std::is_same_v<_T, float>
+                          || std::is_same_v<_T, double>
+                          || std::is_same_v<_T, long double>
+                          || std::is_same_v<_T, std::string> )>
+    {};
+  // whether convert<_T> can be linked: the builtin types, and
+  // kt-args-convert.hpp extends it to anything else streamable with >>
+  template<typename _T, typename = void>
+  struct has_convert : builtin_convert<_T> {};
+  template<typename _T>
+  constexpr auto check_convert() -> void
+    {
+      static_assert(has_convert<_T>::value,
+                    "kt::args has no conversion for this type: include kt-args-convert.hpp "
+                    "if it is streamable with operator>>, or bind it with choice() or a "
+                    "custom sender");
+    }
+  // values that can be stored in a snapshot byte for byte: arithmetic
+  // types, enums, durations, byte_size and rate, and optionals of them.
+  // anything else may hold a pointer, which would not survive the trip
+  // to another process
+  template<typename _T>
+  struct is_storable
+      : std::bool_constant<( (std::is_arithmetic_v<_T> || std::is_enum_v<_T>)
+                          && not std::is_const_v<_T> )>
+    {};
+  template<typename _Rep, typename _Period>
+  struct is_storable<std::chrono::duration<_Rep, _Period>> : is_storable<_Rep> {};
+  template<typename _T>
+  struct is_storable<std::optional<_T>> : is_storable<_T> {};
+  template<typename _T>
+  auto codec_for(_T& _ref) -> value_codec
+    {
+      return value_codec
+        { sizeof(_T)
+        , hash(util::type_name<_T>(), sizeof(_T))
+        , [&_ref](std::string& _buf) { _buf.append(reinterpret_cast<const char*>(&_ref), sizeof(_T)); }
+        , [&_ref](const char* _bytes) { std::memcpy(&_ref, _bytes, sizeof(_T)); }
+        };
+    }
+  template<typename _T, typename _FN>
+  auto with_codec(_T& _ref, _FN _sender)
+    {
+      if constexpr(is_storable<_T>::value)
+      {
+        return stored_sender<_FN> { std::move(_sender), codec_for(_ref) };
+      }
+      else
+      {
+        return _sender;
+      }
+    }
+} /* namespace detail */
 template<typename _T>
 auto ref(_T&& _ref)
   {
     using ref_type = std::decay_t<_T>;
-    return [&](value_arg _varg)
+    return detail::with_codec(_ref, [&](value_arg _varg)
       {
         const auto& opt = _varg.first;
-        if constexpr(std::is_same_v<_T, ::std::string_view>)
+        if constexpr(std::is_same_v<ref_type, ::std::string_view>)
         {
           _ref = _varg.second;
         }
         else
         {
+          detail::check_convert<ref_type>();
           auto value = _varg.second;
-          try
-          {
-            _ref = boost::lexical_cast<ref_type>(value);
-          } 
-          catch(const boost::bad_lexical_cast& _error)
+          if(not detail::convert(value, _ref))
           {
-            throw err_ref_conversion<ref_type>(opt, value);
+            throw err_ref_conversion(opt, value, type_name<ref_type>());
           }
         }
-      };
+      });
   }
 
 template<typename _T>
 auto ref(std::optional<_T>& _ref)
   {
     using ref_type = std::decay_t<_T>;
-    return [&](opt_value_arg _varg)
+    return detail::with_codec(_ref, [&](opt_value_arg _varg)
       {
         const auto& opt = _varg.first;
         auto value_ptr = _varg.second;
@@ -290,21 +386,20 @@ auto ref(std::optional<_T>& _ref)
           }
           else
           {
-            try
+            detail::check_convert<ref_type>();
+            auto tmp = ref_type {};
+            if(not detail::convert(*value_ptr, tmp))
             {
-              _ref = boost::lexical_cast<ref_type>(*value_ptr);
-            }
-            catch(const boost::bad_lexical_cast& _error)
-            {
-              throw err_ref_conversion<ref_type>(opt, *value_ptr);
+              throw err_ref_conversion(opt, *value_ptr, type_name<ref_type>());
             }
+            _ref = std::move(tmp);
           }
         }
-      };
+      });
   }
 namespace detail {
   template<size_t _I, typename..._Ts>
-  auto variant_ref(std::variant<_Ts...>& _var, value_arg _varg, std::stringstream& _errmsg) -> void
+  auto variant_ref(std::variant<_Ts...>& _var, value_arg _varg, std::string& _errmsg) -> void
     {
       using namespace std;
       using variant_type = decay_t<decltype(_var)>;
@@ -316,8 +411,9 @@ namespace detail {
       }
       else
       {
+        check_convert<value_type>();
         auto tmp = value_type {};
-        if(boost::conversion::try_lexical_convert(_varg.second, tmp))
+        if(convert(_varg.second, tmp))
         {
           _var = tmp;
         }
@@ -325,13 +421,16 @@ namespace detail {
         {
           if constexpr(_I == 0)
           {
-            _errmsg << "option '" << longest_name(_varg.first) 
-                    << "' must be one of the following types: "
-                    << type_name<value_type>();
+            _errmsg += "option '";
+            _errmsg += longest_name(_varg.first);
+            _errmsg += "' must be one of the following types: ";
+            _errmsg += type_name<value_type>();
           }
           else
           {
-            _errmsg << (type_count > 2? ", " : " ") << (_I + 1 == type_count? "or " : "") << type_name<value_type>();
+            _errmsg += (type_count > 2? ", " : " ");
+            _errmsg += (_I + 1 == type_count? "or " : "");
+            _errmsg += type_name<value_type>();
           }
           constexpr auto next_idx = _I + 1;
           if constexpr(next_idx < type_count)
@@ -340,7 +439,7 @@ namespace detail {
           }
           else
           {
-            throw std::runtime_error{_errmsg.str()};
+            throw std::runtime_error{_errmsg};
           }
         }
       }
@@ -351,301 +450,671 @@ auto variant_ref(std::variant<_Ts...>& _var)
   {
     return [&](value_arg _varg)
     {
-      auto msg = std::stringstream {};
+      auto msg = std::string {};
       detail::variant_ref<0>(_var, _varg, msg); 
     };
   }
 
-
-class parser
+// string -> enum table with a perfect hash built at construction time,
+// so a lookup is two hashes and one string compare no matter how many
+// choices there are. construct it constexpr to build the hash at
+// compile time:
+//
+//   constexpr auto modes = args::choices<mode>({ { "fast", mode::fast }, ... });
+//
+// the hash is two-level ("hash and displace"): the first hash picks a
+// bucket, and each bucket stores the seed of a second hash that sends
+// every key in the bucket to its own slot.
+template<typename _E, size_t _N>
+class choice_table
 {
-private:
-  using positional_fn = std::function<void(value_type)>;
-  template<typename _FN>
-  static constexpr auto sender_is_meta()
+  static_assert(_N > 0, "a choice table needs at least one entry");
+public:
+  using entry         = std::pair<std::string_view, _E>;
+  using entry_store   = std::array<entry, _N>;
+
+  constexpr explicit choice_table(const entry (&_entries)[_N])
     {
-      using fn_type = std::decay_t<_FN>;
-      return std::is_same_v<fn_type, opt::meta_value_fn>;
+      for(size_t i = 0; i < _N; ++i)
+      {
+        entries_[i] = _entries[i];
+      }
+      build();
     }
-  template<typename _FN>
-  static constexpr auto sender_has_value()
+  constexpr auto find(std::string_view _key) const -> const entry*
     {
-      using fn_type = std::decay_t<_FN>;
-      return std::is_same_v<fn_type, opt::value_fn>;
+      auto bucket = detail::hash(_key, 0) & (bucket_count - 1);
+      auto slot   = detail::hash(_key, seeds_[bucket]) & (slot_count - 1);
+      auto idx    = slots_[slot];
+      if(idx == 0 || entries_[idx - 1].first != _key) return nullptr;
+      return &entries_[idx - 1];
     }
-  template<typename _FN>
-  static constexpr auto sender_has_opt_value()
+  constexpr auto entries() const -> const entry_store& { return entries_; }
+private:
+  static constexpr auto bucket_count  = std::bit_ceil(_N);
+  static constexpr auto slot_count    = bucket_count * 2;
+  static constexpr auto max_seed      = uint32_t { 1 } << 20;
+  using slot_type = std::conditional_t<(_N < 0xffff), uint16_t, uint32_t>;
+  constexpr auto build() -> void
     {
-      using fn_type = std::decay_t<_FN>;
-      return std::is_same_v<fn_type, opt::opt_value_fn>;
+      // group the entry indices by bucket (counting sort)
+      auto bucket_of    = std::array<size_t, _N> {};
+      auto bucket_start = std::array<size_t, bucket_count + 1> {};
+      auto members      = std::array<size_t, _N> {};
+      auto max_size     = size_t { 0 };
+      for(size_t i = 0; i < _N; ++i)
+      {
+        bucket_of[i] = detail::hash(entries_[i].first, 0) & (bucket_count - 1);
+        ++bucket_start[bucket_of[i] + 1];
+      }
+      for(size_t bucket = 0; bucket < bucket_count; ++bucket)
+      {
+        max_size = std::max(max_size, bucket_start[bucket + 1]);
+        bucket_start[bucket + 1] += bucket_start[bucket];
+      }
+      auto fill = bucket_start;
+      for(size_t i = 0; i < _N; ++i)
+      {
+        // equal names always share a bucket, so only check there
+        for(auto n = bucket_start[bucket_of[i]]; n < fill[bucket_of[i]]; ++n)
+        {
+          if(entries_[members[n]].first == entries_[i].first)
+          {
+            throw std::logic_error { "duplicate choice name" };
+          }
+        }
+        members[fill[bucket_of[i]]++] = i;
+      }
+      // place the largest buckets first while the slot table is empty
+      auto taken = std::array<size_t, _N> {};
+      for(auto size = max_size; size > 0; --size)
+      {
+        for(size_t bucket = 0; bucket < bucket_count; ++bucket)
+        {
+          auto first = bucket_start[bucket];
+          if(bucket_start[bucket + 1] - first != size) continue;
+          auto placed = false;
+          auto seed   = uint32_t { 0 };
+          while(not placed && ++seed < max_seed)
+          {
+            placed = true;
+            for(size_t n = 0; placed && n < size; ++n)
+            {
+              auto slot = detail::hash(entries_[members[first + n]].first, seed) & (slot_count - 1);
+              placed = slots_[slot] == 0
+                    && std::find(taken.begin(), taken.begin() + n, slot) == taken.begin() + n;
+              taken[n] = slot;
+            }
+          }
+          if(not placed)
+          {
+            throw std::logic_error { "could not build choice table" };
+          }
+          seeds_[bucket] = seed;
+          for(size_t n = 0; n < size; ++n)
+          {
+            slots_[taken[n]] = static_cast<slot_type>(members[first + n] + 1);
+          }
+        }
+      }
     }
+  entry_store                             entries_  {};
+  std::array<uint32_t, bucket_count>      seeds_    {};
+  // index + 1 into entries_; 0 marks an empty slot
+  std::array<slot_type, slot_count>       slots_    {};
+};
+template<typename _E, size_t _N>
+constexpr auto choices(const std::pair<std::string_view, _E> (&_entries)[_N])
+  {
+    return choice_table<_E, _N> { _entries };
+  }
+
+template<typename _E, size_t _N>
+class choice_ref
+{
 public:
-  auto matches() const -> const match_store& { return matches_; }
-  auto add_match(const opt& _opt, std::optional<value_type> _value) -> void
+  using table_type = choice_table<_E, _N>;
+  choice_ref(_E& _ref, const table_type& _table)
+      : ref_(_ref)
+      , table_(_table)
+    {}
+  auto sender() const
     {
-      matches_.emplace_back(_opt, _value);
+      return [ref = &ref_, table = &table_](value_arg _varg)
+        {
+          const auto* found = table->find(_varg.second);
+          if(found == nullptr)
+          {
+            throw err_invalid_choice(_varg.first, _varg.second);
+          }
+          *ref = found->second;
+        };
     }
-  auto send()    const -> void
+  // the id also covers the table, so a parser whose table maps other
+  // names or values does not accept this one's stored value
+  auto codec() const -> std::optional<value_codec>
     {
-      if(not stop_parsing_)
+      if constexpr(detail::is_storable<_E>::value)
       {
-        for(const auto& match : matches_)
+        auto result = detail::codec_for(ref_);
+        for(const auto& [name, value] : table_.entries())
         {
-          const auto& [opt, value] = match;
-          opt.send(value);
+          if constexpr(std::is_enum_v<_E>)
+          {
+            result.id = detail::hash(name, result.id ^ static_cast<uint64_t>(static_cast<std::underlying_type_t<_E>>(value)));
+          }
+          else
+          {
+            result.id = detail::hash(name, result.id ^ static_cast<uint64_t>(value));
+          }
         }
+        return result;
+      }
+      else
+      {
+        return std::nullopt;
       }
     }
-  auto operator()(const positional_fn& _fn)
+  auto names() const -> choice_names
     {
+      auto result = choice_names {};
+      result.reserve(_N);
+      for(const auto& [name, value] : table_.entries())
+      {
+        result.emplace_back(name);
+      }
+      return result;
     }
-  auto operator()(opt _o) -> parser&
+private:
+  _E&               ref_;
+  const table_type& table_;
+};
+// the table is held by reference, so it must outlive the parser; it is
+// meant to be a constexpr global
+template<typename _E, size_t _N>
+auto choice(_E& _ref, const choice_table<_E, _N>& _table)
+  {
+    return choice_ref<_E, _N> { _ref, _table };
+  }
+template<typename _E, size_t _N>
+auto choice(_E& _ref, const choice_table<_E, _N>&& _table) = delete;
+
+// a size in bytes, e.g. "512MiB". decimal (k, M, G, ...) and binary
+// (Ki, Mi, Gi, ...) prefixes are accepted, with or without a trailing B.
+struct byte_size
+{
+  uint64_t bytes = 0;
+  auto operator<=>(const byte_size&) const = default;
+};
+// an event count per interval, e.g. "10k/s" or "300/5min"
+struct rate
+{
+  uint64_t                  count = 0;
+  std::chrono::nanoseconds  per   = std::chrono::seconds { 1 };
+  auto per_second() const -> double
     {
-      using namespace std;
-      opts_.emplace_back(_o);
-      return *this;
+      return static_cast<double>(count) * 1e9 / static_cast<double>(per.count());
     }
-  auto parse(int _ac, char* _av[]) -> parser& 
+  auto operator<=>(const rate&) const = default;
+};
+auto err_unit_conversion(const opt& _opt, std::string_view _sv, std::string_view _what, std::string_view _why) -> std::runtime_error;
+namespace detail {
+  template<>
+  struct is_storable<byte_size> : std::true_type {};
+  template<>
+  struct is_storable<rate> : std::true_type {};
+  // each returns "" on success, or the reason the value was rejected
+  auto parse_size(std::string_view _sv, uint64_t& _out) -> std::string_view;
+  auto parse_rate(std::string_view _sv, rate& _out) -> std::string_view;
+  // read _sv as a duration in ticks of _num/_den seconds, as the exact
+  // fraction _scaled / _den_out. for this and parse_duration, _default
+  // stands in for a missing number, so with 1 "s" reads as "1s"
+  auto parse_ticks(std::string_view _sv, uint64_t _num, uint64_t _den, std::optional<uint64_t> _default,
+                   uint64_t& _scaled, uint64_t& _den_out) -> std::string_view;
+  template<typename _Rep, typename _Period>
+  auto parse_duration(std::string_view _sv, std::chrono::duration<_Rep, _Period>& _out,
+                      std::optional<uint64_t> _default = std::nullopt) -> std::string_view
     {
-      stop_parsing_ = false;
-      using namespace std;
-      matches_.clear();
-      auto args     = span<const char*> { (const char**)_av, (size_t)_ac };
-      auto arg_iter = args.begin();
-      auto parse_short = 
-        [&](auto arg) -> void
+      auto scaled = uint64_t { 0 };
+      auto den    = uint64_t { 0 };
+      if(auto why = parse_ticks(_sv, _Period::num, _Period::den, _default, scaled, den); not why.empty()) return why;
+      if constexpr(std::is_floating_point_v<_Rep>)
+      {
+        _out = std::chrono::duration<_Rep, _Period> { static_cast<_Rep>(scaled) / static_cast<_Rep>(den) };
+      }
+      else
+      {
+        if(scaled % den != 0) return "value is not a whole number of ticks";
+        auto ticks = scaled / den;
+        if(ticks > static_cast<std::make_unsigned_t<_Rep>>(std::numeric_limits<_Rep>::max()))
         {
-          auto compare = string { "--" };
-          bool stop_parsing_short_arg = false;
-          for(size_t arg_idx = 1; arg_idx < arg.size(); ++arg_idx)
-          {
-            if(stop_parsing_ || stop_parsing_short_arg) break;
-            auto extract_short_value =
-              [&]() -> optional<string_view>
-              {
-                auto value = std::optional<string_view> {};
-                // try to extract the arg value from the current
-                // arg
-                auto next_idx = arg_idx + 1;
-                // if we have more short opt chars available...
-                if(next_idx < arg.size())
-                {
-                  // ...extract the value from it
-                  auto value_tmp = arg.substr(next_idx);   
-                  // skip the first '=' char, if it exists
-                  if(not value_tmp.empty() && value_tmp[0] == '=') value_tmp.remove_prefix(1);
-                  value = value_tmp;
-                  // cause the short arg iterator loop to exit
-                  stop_parsing_short_arg = true;
-                }
-                else
-                {
-                  // throw err_invalid_value();
-                  // peek at the next arg
-                  auto next_arg_iter = arg_iter + 1;  
-                  auto no_more_args = next_arg_iter == args.end();
-                  if(no_more_args)
-                  {
-                    return std::nullopt;
-                  }
-                  auto next_arg = string_view { *next_arg_iter };
-                  auto arg_is_value = (not arg_is_short(next_arg))
-                                  and (not opt_is_long(next_arg));
-                  if(arg_is_value)
-                  {
-                    value = next_arg;
-                    arg_iter = next_arg_iter;
-                  }
-                  else
-                  {
-                    return std::nullopt;
-                  }
-                }
-                return value;
-              };
-            compare[1] = arg[arg_idx];
-            auto found_match = false;
-            for(const auto& opt : opts_)
-            {
-              const auto& opt_name = opt.short_name();
-              if(opt_name.has_value() && *opt_name == compare)
-              {
-                found_match = true;
-                const auto& opt_action = opt.action();
-                std::visit
-                  ( [&](auto&& _send)
-                    {
-                      using fn_type = decay_t<decltype(_send)>;
-                      if constexpr(sender_has_value<fn_type>())
-                      {
-                        auto value = extract_short_value();
-                        //if(not value.has_value())
-                        //{
-                        //  throw err_arg_required(compare);
-                        //}
-                        add_match(opt, value);
-                      }
-                      else if constexpr(sender_has_opt_value<fn_type>())
-                      {
-                        auto value = extract_short_value();
-                        //_send(opt_value_arg(opt, value? &(*value) : nullptr));
-                        add_match(opt, value);
-                      }
-                      else if constexpr(sender_is_meta<fn_type>())
-                      {
-                        auto meta     = meta_arg   { opt, *this };
-                        _send(meta);
-                      }
-                      else
-                      {
-                        auto next_idx = arg_idx + 1;
-                        if(next_idx < arg.size() && arg[next_idx] == '=')
-                        {
-                          throw err_invalid_value(compare);
-                        }
-                        //_send(opt);
-                        add_match(opt, nullopt);
-                      }
-                    }
-                  , opt_action
-                  );
-
-              }
-            }
-            if(not found_match)
-            {
-              throw err_invalid_arg(compare);
-            }
-          }
-        };
-      auto parse_long  = [&](auto arg) 
+          return "value out of range";
+        }
+        _out = std::chrono::duration<_Rep, _Period> { static_cast<_Rep>(ticks) };
+      }
+      return "";
+    }
+} /* namespace detail */
+template<typename _Rep, typename _Period>
+auto ref(std::chrono::duration<_Rep, _Period>& _ref)
+  {
+    return detail::with_codec(_ref, [&](value_arg _varg)
+      {
+        if(auto why = detail::parse_duration(_varg.second, _ref); not why.empty())
         {
-          auto arg_name     = string_view {};
-          auto arg_value    = optional<string_view> {};
-          auto delim_pos    = min(arg.find('='), arg.size());
-          auto delim_found  = delim_pos != arg.size();
-          if(not delim_found)
-          {
-            arg_name = arg;
-          }
-          else
-          {
-            auto value_start = std::min(delim_pos + 1, arg.size());
-            arg_name  = arg.substr(0, delim_pos);
-            arg_value = arg.substr(value_start);
-          }
-          auto extract_long_value = [&]() -> std::optional<value_type>
-            {
-              if(arg_value.has_value()) return arg_value;
-              auto next_arg_iter = arg_iter + 1;
-              if(next_arg_iter == args.end())
-              {
-                return nullopt;
-              }
-              auto next_arg = string_view { *next_arg_iter };
-              if(arg_is_opt(next_arg))
-              {
-                return nullopt;
-              }
-              arg_iter = next_arg_iter;
-              return next_arg;
-            };
-          auto found_match = false;
-          for(auto& opt : opts_)
-          {
-            auto opt_name = opt.long_name();
-            if(opt_name.has_value() && *opt_name == arg_name)
-            {
-              found_match = true;
-              std::visit
-                ( [&](auto&& _send)
-                  {
-                    using fn_type = decay_t<decltype(_send)>;
-                    if constexpr(sender_has_value<fn_type>())
-                    {
-                      auto value = extract_long_value();        
-                      //if(not value.has_value())
-                      //{
-                      //  throw err_arg_required(*opt_name);
-                      //}
-                      add_match(opt, value);
-                    }
-                    else if constexpr(sender_has_opt_value<fn_type>())
-                    {
-                      auto value = extract_long_value(); 
-                      add_match(opt, value);
-                    }
-                    else if constexpr(sender_is_meta<fn_type>())
-                    {
-                      auto meta     = meta_arg   { opt, *this };
-                      _send(meta);
-                    }
-                    else
-                    {
-                      //if(arg_value.has_value())
-                      //{
-                      //  throw err_invalid_value(arg_name);
-                      //}
-                      add_match(opt, nullopt);
-                    }
-                  }
-                , opt.action()
-                );
-            }
-          }
-          if(not found_match)
+          throw err_unit_conversion(_varg.first, _varg.second, "a duration", why);
+        }
+      });
+  }
+inline auto ref(byte_size& _ref)
+  {
+    return detail::with_codec(_ref, [&](value_arg _varg)
+      {
+        if(auto why = detail::parse_size(_varg.second, _ref.bytes); not why.empty())
+        {
+          throw err_unit_conversion(_varg.first, _varg.second, "a byte size", why);
+        }
+      });
+  }
+inline auto ref(rate& _ref)
+  {
+    return detail::with_codec(_ref, [&](value_arg _varg)
+      {
+        if(auto why = detail::parse_rate(_varg.second, _ref); not why.empty())
+        {
+          throw err_unit_conversion(_varg.first, _varg.second, "a rate", why);
+        }
+      });
+  }
+namespace detail {
+  // the optional form of the unit refs: no value resets _ref, otherwise
+  // _parse reads it into a temporary that replaces _ref
+  template<typename _T, typename _FN>
+  auto optional_unit_ref(std::optional<_T>& _ref, std::string_view _what, _FN _parse)
+    {
+      return with_codec(_ref, [&_ref, _what, _parse](opt_value_arg _varg)
+        {
+          if(_varg.second == nullptr)
           {
-            throw err_invalid_arg(arg_name);
+            _ref = std::nullopt;
+            return;
           }
-        };
-      auto parse_positional = [&](auto arg)
-        {
-          for(const auto& opt : opts_)
+          auto tmp = _T {};
+          if(auto why = _parse(*_varg.second, tmp); not why.empty())
           {
-            if(opt.is_positional())
-            {
-              add_match(opt, arg);
-            }
+            throw err_unit_conversion(_varg.first, *_varg.second, _what, why);
           }
-        };
-      auto exec_name = *arg_iter;
-      ++arg_iter;
-      while(arg_iter != args.end())
+          _ref = tmp;
+        });
+    }
+} /* namespace detail */
+template<typename _Rep, typename _Period>
+auto ref(std::optional<std::chrono::duration<_Rep, _Period>>& _ref)
+  {
+    using duration_type = std::chrono::duration<_Rep, _Period>;
+    return detail::optional_unit_ref(_ref, "a duration",
+      [](std::string_view _sv, duration_type& _out) { return detail::parse_duration(_sv, _out); });
+  }
+inline auto ref(std::optional<byte_size>& _ref)
+  {
+    return detail::optional_unit_ref(_ref, "a byte size",
+      [](std::string_view _sv, byte_size& _out) { return detail::parse_size(_sv, _out.bytes); });
+  }
+inline auto ref(std::optional<rate>& _ref)
+  {
+    return detail::optional_unit_ref(_ref, "a rate",
+      [](std::string_view _sv, rate& _out) { return detail::parse_rate(_sv, _out); });
+  }
+
+struct arity
+{
+  static constexpr auto unbounded = std::numeric_limits<size_t>::max();
+  size_t min = 0;
+  size_t max = unbounded;
+};
+
+// declares the positional arguments a program accepts. unlike a
+// positional opt (an opt with an empty name), a positional spec never
+// produces per-argument matches; the arguments are collected into a
+// positional_range instead.
+class positional
+{
+  using name_type     = std::string_view;
+  using desc_type     = std::string_view;
+public:
+  positional(name_type _n, arity _a = {}, desc_type _d = "")
+      : name_   (_n)
+      , arity_  (_a)
+      , desc_   (_d)
+    {
+      assert(arity_.min <= arity_.max);
+    }
+  auto name()  const -> name_type         { return name_; }
+  auto range() const -> const arity&      { return arity_; }
+  auto desc()  const -> const desc_type&  { return desc_; }
+private:
+  name_type     name_;
+  arity         arity_;
+  desc_type     desc_;
+};
+
+// lazy view over the positional arguments of a parse. the arguments are
+// never copied: the range only remembers the runs of consecutive argv
+// slots that held positionals, and yields string_views into argv on
+// iteration. segments() exposes those runs directly, e.g. for handing
+// disjoint chunks to worker threads.
+class positional_range
+{
+public:
+  using segment_store = std::vector<arg_span>;
+  class iterator
+  {
+  public:
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator() = default;
+    explicit iterator(segment_store::const_iterator _seg)
+        : seg_(_seg)
+      {}
+    auto operator*() const -> value_type { return value_type { (*seg_)[idx_] }; }
+    auto operator++() -> iterator&
       {
-        if(stop_parsing_) break;
-        auto arg = string_view { *arg_iter };
-        if(arg_is_short(arg))
+        if(++idx_ == seg_->size())
         {
-          parse_short(arg);
+          ++seg_;
+          idx_ = 0;
         }
-        else if(arg_is_long(arg))
+        return *this;
+      }
+    auto operator++(int) -> iterator { auto tmp = *this; ++*this; return tmp; }
+    auto operator==(const iterator& _rhs) const -> bool
+      {
+        return seg_ == _rhs.seg_ && idx_ == _rhs.idx_;
+      }
+  private:
+    segment_store::const_iterator seg_;
+    size_t                        idx_ = 0;
+  };
+
+  auto begin()    const -> iterator             { return iterator { segments_.begin() }; }
+  auto end()      const -> iterator             { return iterator { segments_.end() }; }
+  auto size()     const -> size_t               { return size_; }
+  auto empty()    const -> bool                 { return size_ == 0; }
+  auto segments() const -> const segment_store& { return segments_; }
+
+  auto clear() -> void
+    {
+      segments_.clear();
+      size_ = 0;
+    }
+  // record the argv slots [_first, _first + _count); runs that continue
+  // the previous segment are merged into it.
+  auto append(const char** _first, size_t _count) -> void
+    {
+      if(_count == 0) return;
+      if(not segments_.empty())
+      {
+        auto& last = segments_.back();
+        if(last.data() + last.size() == _first)
         {
-          parse_long(arg);
+          last = arg_span { last.data(), last.size() + _count };
+          size_ += _count;
+          return;
         }
-        else
+      }
+      segments_.emplace_back(_first, _count);
+      size_ += _count;
+    }
+private:
+  segment_store segments_;
+  size_t        size_ = 0;
+};
+static_assert(std::forward_iterator<positional_range::iterator>);
+
+// a set of opts, by their index in the parser's opt list
+class opt_set
+{
+  using word_type = uint64_t;
+  static constexpr auto word_bits = size_t { 64 };
+public:
+  auto set(size_t _idx) -> void
+    {
+      if(_idx / word_bits >= words_.size()) words_.resize(_idx / word_bits + 1);
+      words_[_idx / word_bits] |= bit(_idx);
+    }
+  auto test(size_t _idx) const -> bool
+    {
+      return _idx / word_bits < words_.size() && (words_[_idx / word_bits] & bit(_idx)) != 0;
+    }
+  // clear every bit, keeping room for _size opts
+  auto reset(size_t _size) -> void
+    {
+      words_.assign((_size + word_bits - 1) / word_bits, 0);
+    }
+  auto empty() const -> bool
+    {
+      return std::all_of(words_.begin(), words_.end(), [](auto _w) { return _w == 0; });
+    }
+  auto subset_of(const opt_set& _rhs) const -> bool
+    {
+      for(size_t i = 0; i < words_.size(); ++i)
+      {
+        if((words_[i] & ~_rhs.word(i)) != 0) return false;
+      }
+      return true;
+    }
+  auto intersect_count(const opt_set& _rhs) const -> size_t
+    {
+      auto count = size_t { 0 };
+      for(size_t i = 0; i < words_.size(); ++i)
+      {
+        count += std::popcount(words_[i] & _rhs.word(i));
+      }
+      return count;
+    }
+  template<typename _FN>
+  auto for_each(_FN&& _fn) const -> void
+    {
+      for(size_t i = 0; i < words_.size(); ++i)
+      {
+        for(auto w = words_[i]; w != 0; w &= w - 1)
         {
-          parse_positional(arg);
+          _fn(i * word_bits + std::countr_zero(w));
         }
-        ++arg_iter;
       }
+    }
+private:
+  static constexpr auto bit(size_t _idx) -> word_type { return word_type { 1 } << (_idx % word_bits); }
+  auto word(size_t _i) const -> word_type { return _i < words_.size()? words_[_i] : 0; }
+  std::vector<word_type> words_;
+};
+
+enum class violation_kind
+{
+  missing_required,     // opts: the required opts that were not given
+  mutually_exclusive,   // opts: the conflicting opts that were given
+  missing_dependency,   // opts: the dependent opt, then what it needs
+};
+struct violation
+{
+  violation_kind                kind;
+  std::vector<std::string_view> opts;
+};
+using violation_store = std::vector<violation>;
+
+class constraint_error : public std::runtime_error
+{
+public:
+  explicit constraint_error(violation_store _v)
+      : std::runtime_error(describe(_v))
+      , violations_(std::move(_v))
+    {}
+  auto violations() const -> const violation_store& { return violations_; }
+private:
+  static auto describe(const violation_store& _violations) -> std::string;
+  violation_store violations_;
+};
+
+class parser
+{
+private:
+  template<typename _FN>
+  static constexpr auto sender_is_meta()
+    {
+      using fn_type = std::decay_t<_FN>;
+      return std::is_same_v<fn_type, opt::meta_value_fn>;
+    }
+  template<typename _FN>
+  static constexpr auto sender_has_value()
+    {
+      using fn_type = std::decay_t<_FN>;
+      return std::is_same_v<fn_type, opt::value_fn>;
+    }
+  template<typename _FN>
+  static constexpr auto sender_has_opt_value()
+    {
+      using fn_type = std::decay_t<_FN>;
+      return std::is_same_v<fn_type, opt::opt_value_fn>;
+    }
+public:
+  auto matches() const -> const match_store& { return matches_; }
+  auto add_match(const opt& _opt, std::optional<value_type> _value) -> void
+    {
+      auto idx = static_cast<size_t>(&_opt - opts_.data());
+      if(idx < opts_.size()) seen_.set(idx);
+      matches_.emplace_back(_opt, _value);
+    }
+  auto send()    const -> void;
+  auto operator()(positional _p) -> parser&
+    {
+      // halting on a positional leaves none to count
+      assert(not halt_on_positional_);
+      positional_.emplace(_p);
       return *this;
     }
+  auto operator()(opt _o) -> parser&
+    {
+      using namespace std;
+      has_positional_opt_ = has_positional_opt_ || _o.is_positional();
+      opts_.emplace_back(_o);
+      return *this;
+    }
+  auto parse(int _ac, char* _av[]) -> parser&;
   auto operator()(int _ac, char* _av[]) -> parser& 
     {
       return parse(_ac, _av);
     }
+  // a hash of everything that decides what a parse produces: the opts,
+  // the kind of value each takes, the positional spec, the constraints
+  // and the halt settings. a snapshot is only loaded by a parser with
+  // the same spec hash.
+  auto spec_hash() const -> uint64_t;
+  // serialize the result of the last parse(): the matches, as opt
+  // indices and raw values, the positionals, and where a halted parse
+  // stopped. taken after send(), it also holds the converted value of
+  // every seen opt whose sender has a codec (ref() of an arithmetic
+  // value, an enum, a duration or unit, and choice()). a parser with the
+  // same spec can load() it and send() without parsing argv again; each
+  // of those values is written back in place of its opt's last match.
+  auto snapshot() const -> std::string;
+  // restore the state saved by snapshot(). returns false, leaving the
+  // parser empty, if the blob is malformed, from another version, was
+  // taken with a different spec, or breaks this parser's constraints.
+  // a halted snapshot also needs an argv of the same length, from which
+  // tail() is rebuilt; without one it is refused.
+  auto load(std::string_view _blob, int _ac = 0, char* _av[] = nullptr) -> bool;
+  // load _snapshot if it matches this spec, otherwise parse argv
+  auto parse(int _ac, char* _av[], std::string_view _snapshot) -> parser&
+    {
+      if(load(_snapshot, _ac, _av)) return *this;
+      return parse(_ac, _av);
+    }
+  // constraints name opts by their short or long name, and must be
+  // declared after the opts they refer to. they are checked at the end
+  // of parse(), which throws a constraint_error listing every violation.
+  auto require(std::initializer_list<std::string_view> _names) -> parser&
+    {
+      for(auto name : _names) required_.set(index_of(name));
+      return *this;
+    }
+  auto exclusive(std::initializer_list<std::string_view> _names) -> parser&
+    {
+      auto& group = exclusive_.emplace_back();
+      for(auto name : _names) group.set(index_of(name));
+      return *this;
+    }
+  auto depends(std::string_view _name, std::initializer_list<std::string_view> _needs) -> parser&
+    {
+      auto& [idx, needs] = depends_.emplace_back(index_of(_name), opt_set {});
+      for(auto name : _needs) needs.set(index_of(name));
+      return *this;
+    }
+  // check the constraints against the opts seen by the last parse()
+  auto check() const -> violation_store;
+  // stop parsing when the exact token _name (e.g. "--exec") is seen.
+  // the token itself is consumed; everything after it is left in tail()
+  auto halt_on(std::string_view _name) -> parser&
+    {
+      assert(opt_is_short(_name) || opt_is_long(_name));
+      halt_names_.emplace_back(_name);
+      return *this;
+    }
+  // stop parsing at the first positional argument, which becomes the
+  // first element of tail(). a "--" also halts, and is consumed. an opt
+  // with an optional value only takes it when attached ("--color=auto",
+  // "-cauto"), so "--color ls" hands "ls" on. this cannot be combined
+  // with a positional spec, since no positional is ever collected.
+  auto halt_on_positional(bool _halt = true) -> parser&
+    {
+      assert(not (_halt && positional_.has_value()));
+      halt_on_positional_ = _halt;
+      return *this;
+    }
   
   
   
   
   
   auto opts() const -> const opt_store& { return opts_; }
+  auto positional_spec() const -> const std::optional<positional>& { return positional_; }
+  auto positionals() const -> const positional_range& { return positionals_; }
+  auto seen() const -> const opt_set& { return seen_; }
+  auto halted() const -> bool { return halted_; }
+  // the unparsed remainder of argv after a halt. this is a view into the
+  // argv passed to parse(); since argv[argc] is null, tail().data() can be
+  // handed straight to execv().
+  auto tail() const -> std::span<char*> { return tail_; }
   auto stop_parsing() { stop_parsing_ = true; }
 private:
-  opt_store       opts_;
-  match_store     matches_;
-  opt*            help_opt_ = nullptr;
-  bool            stop_parsing_ = false;
+  static constexpr auto snapshot_magic    = uint32_t { 0x5241544b }; // "KTAR"
+  static constexpr auto snapshot_version  = uint32_t { 3 };
+  using dependency_store = std::vector<std::pair<size_t, opt_set>>;
+  auto index_of(std::string_view _name) const -> size_t;
+  opt_store                 opts_;
+  std::optional<positional> positional_;
+  match_store               matches_;
+  positional_range          positionals_;
+  bool                      has_positional_opt_ = false;
+  opt_set                   seen_;
+  opt_set                   required_;
+  std::vector<opt_set>      exclusive_;
+  dependency_store          depends_;
+  halt_store                halt_names_;
+  bool                      halt_on_positional_ = false;
+  bool                      halted_ = false;
+  std::span<char*>          tail_;
+  size_t                    argc_ = 0;
+  std::string               snapshot_buf_;
+  std::vector<const char*>  snapshot_args_;
+  // converted values from a loaded snapshot, as views into snapshot_buf_,
+  // keyed and sorted by the position of their opt's last match
+  std::vector<std::pair<size_t, std::string_view>> stored_values_;
+  opt_set                   restored_;
+  mutable bool              sent_ = false;
+  opt*                      help_opt_ = nullptr;
+  bool                      stop_parsing_ = false;
 };
 template<typename OS>
 class help_opt
@@ -664,12 +1133,11 @@ public:
             auto has_short_name = _opt.short_name().has_value();
             auto has_long_name  = _opt.long_name().has_value();
             auto has_both_names = has_short_name && has_long_name;
-            auto ss = std::stringstream {};
-            ss << (has_short_name? _opt.short_name().value() : "")
-               << (has_both_names? ", " : "")
-               << (has_long_name?  _opt.long_name() .value() : "")
-               ;
-            return ss.str();
+            auto names = std::string {};
+            names += (has_short_name? _opt.short_name().value() : "");
+            names += (has_both_names? ", " : "");
+            names += (has_long_name?  _opt.long_name() .value() : "");
+            return names;
           };
         auto& [help_opt, parser]  = _meta;
         parser.stop_parsing();
@@ -683,12 +1151,36 @@ public:
         table_type table;
 
         auto max_names_width = size_t { 0 };
+        auto desc_of = [](const auto& _opt)
+          {
+            auto desc = std::string { _opt.desc() };
+            if(not _opt.choices().empty())
+            {
+              desc += desc.empty()? "{" : " {";
+              auto first = true;
+              for(const auto& name : _opt.choices())
+              {
+                desc += first? "" : "|";
+                desc += name;
+                first = false;
+              }
+              desc += "}";
+            }
+            return desc;
+          };
         for(const auto& opt : parser.opts())
         {
-          auto& row = table.emplace_back(row_type { name_list(opt), opt.desc() });
+          auto& row = table.emplace_back(row_type { name_list(opt), desc_of(opt) });
           const auto& [names, desc] = row;
           max_names_width = std::max(max_names_width, names.size());
         }
+        if(const auto& pos = parser.positional_spec(); pos.has_value())
+        {
+          auto names = std::string { pos->name() };
+          if(pos->range().max > 1) names += "...";
+          max_names_width = std::max(max_names_width, names.size());
+          table.emplace_back(row_type { std::move(names), pos->desc() });
+        }
         for(const auto& row : table)
         {
           const auto& [names, desc] = row;
@@ -0,0 +1,183 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "kt-args.hpp"
+
+namespace args = kt::args;
+
+namespace {
+
+auto failures = 0;
+
+#define CHECK(_cond)                                                        \
+  do {                                                                      \
+    if(not (_cond))                                                         \
+    {                                                                       \
+      std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #_cond "\n"; \
+      ++failures;                                                           \
+    }                                                                       \
+  } while(false)
+
+// an argv that outlives the parser looking into it, null terminated like
+// the real one
+struct argv_store
+{
+  argv_store(std::initializer_list<std::string> _args)
+      : args_(_args)
+    {
+      for(auto& arg : args_) ptrs_.emplace_back(arg.data());
+      ptrs_.emplace_back(nullptr);
+    }
+  auto ac() -> int      { return static_cast<int>(args_.size()); }
+  auto av() -> char**   { return ptrs_.data(); }
+private:
+  std::vector<std::string>  args_;
+  std::vector<char*>        ptrs_;
+};
+
+enum class mood { calm, angry };
+constexpr auto moods       = args::choices<mood>({ { "calm", mood::calm }, { "angry", mood::angry } });
+constexpr auto other_moods = args::choices<mood>({ { "calm", mood::angry }, { "angry", mood::calm } });
+
+// the same spec for the parent and the child; the sender of -p records
+// what it sees of -n, to check the order values are restored in
+struct spec
+{
+  int                       num   = 0;
+  std::chrono::milliseconds nap   {};
+  mood                      m     = mood::calm;
+  std::string               name;
+  std::vector<int>          seen_num;
+  std::vector<std::string>  files;
+  args::parser              cli;
+  spec()
+    {
+      cli
+        (args::positional { "FILE", {} })
+        (args::opt { "-n,--num",  args::ref(num) })
+        (args::opt { "--nap",     args::ref(nap) })
+        (args::opt { "--mood",    args::choice(m, moods) })
+        (args::opt { "--name",    args::ref(name) })
+        (args::opt { "-p",        [this](args::no_arg) { seen_num.emplace_back(num); } })
+        .halt_on("--exec");
+    }
+};
+
+auto round_trip() -> void
+{
+  auto argv   = argv_store { "prog", "-p", "-n", "3", "-p", "-n", "7", "--nap", "2s", "--mood", "angry",
+                             "--name", "goose", "a.txt", "b.txt" };
+  auto parent = spec {};
+  parent.cli.parse(argv.ac(), argv.av()).send();
+  auto blob   = parent.cli.snapshot();
+
+  auto child  = spec {};
+  CHECK(child.cli.load(blob));
+  child.cli.send();
+  CHECK(child.num == 7);
+  CHECK(child.nap == std::chrono::seconds { 2 });
+  CHECK(child.m == mood::angry);
+  CHECK(child.name == "goose");
+  CHECK(child.seen_num == parent.seen_num);
+  CHECK((child.seen_num == std::vector<int> { 0, 3 }));
+  auto files = std::vector<std::string> {};
+  for(auto file : child.cli.positionals()) files.emplace_back(file);
+  CHECK((files == std::vector<std::string> { "a.txt", "b.txt" }));
+  CHECK(not child.cli.halted());
+}
+
+auto bad_blobs() -> void
+{
+  auto argv   = argv_store { "prog", "-n", "3", "--mood", "calm", "a.txt" };
+  auto parent = spec {};
+  parent.cli.parse(argv.ac(), argv.av()).send();
+  auto blob   = parent.cli.snapshot();
+  for(size_t size = 0; size < blob.size(); ++size)
+  {
+    auto child = spec {};
+    CHECK(not child.cli.load(blob.substr(0, size)));
+  }
+  auto longer = spec {};
+  CHECK(not longer.cli.load(blob + '\0'));
+  // a huge match count must be refused, not allocated; it follows the
+  // magic, version, hash and four halt words
+  auto huge = blob;
+  for(size_t i = 0; i < 4; ++i) huge[4 + 4 + 8 + 4 * 4 + i] = '\xff';
+  auto child = spec {};
+  CHECK(not child.cli.load(huge));
+  CHECK(child.cli.positionals().size() == 0);
+}
+
+auto fallback() -> void
+{
+  auto argv   = argv_store { "prog", "-n", "3" };
+  auto parent = spec {};
+  parent.cli.parse(argv.ac(), argv.av()).send();
+  auto blob   = parent.cli.snapshot();
+
+  auto other_version = blob;
+  other_version[4] ^= 1;
+  auto child_argv = argv_store { "prog", "-n", "5" };
+  auto child      = spec {};
+  CHECK(not child.cli.load(other_version));
+  child.cli.parse(child_argv.ac(), child_argv.av(), other_version).send();
+  CHECK(child.num == 5);
+
+  // a child binding -n to another type, or with another choice table,
+  // has another spec hash
+  auto as_float = 0.0f;
+  auto floats   = args::parser {};
+  floats(args::positional { "FILE", {} })
+        (args::opt { "-n,--num",  args::ref(as_float) });
+  auto ints     = args::parser {};
+  auto as_int   = 0;
+  ints  (args::positional { "FILE", {} })
+        (args::opt { "-n,--num",  args::ref(as_int) });
+  CHECK(floats.spec_hash() != ints.spec_hash());
+  ints.parse(argv.ac(), argv.av()).send();
+  floats.parse(child_argv.ac(), child_argv.av(), ints.snapshot()).send();
+  CHECK(as_float == 5.0f);
+
+  auto m        = mood::calm;
+  auto table_a  = args::parser {};
+  auto table_b  = args::parser {};
+  table_a(args::opt { "--mood", args::choice(m, moods) });
+  table_b(args::opt { "--mood", args::choice(m, other_moods) });
+  CHECK(table_a.spec_hash() != table_b.spec_hash());
+}
+
+auto halted_tail() -> void
+{
+  auto argv   = argv_store { "prog", "-n", "3", "--exec", "ls", "-l" };
+  auto parent = spec {};
+  parent.cli.parse(argv.ac(), argv.av()).send();
+  CHECK(parent.cli.halted());
+  auto blob   = parent.cli.snapshot();
+
+  auto child  = spec {};
+  CHECK(child.cli.load(blob, argv.ac(), argv.av()));
+  child.cli.send();
+  CHECK(child.num == 3);
+  CHECK(child.cli.halted());
+  CHECK(child.cli.tail().size() == 2);
+  CHECK(child.cli.tail().size() == 2 && std::string_view { child.cli.tail()[0] } == "ls");
+  CHECK(child.cli.tail().data()[child.cli.tail().size()] == nullptr);
+
+  auto no_argv = spec {};
+  CHECK(not no_argv.cli.load(blob));
+  auto short_argv = argv_store { "prog", "-n", "3", "--exec", "ls" };
+  auto mismatched = spec {};
+  CHECK(not mismatched.cli.load(blob, short_argv.ac(), short_argv.av()));
+}
+
+} /* namespace */
+
+auto main() -> int
+{
+  round_trip();
+  bad_blobs();
+  fallback();
+  halted_tail();
+  if(failures == 0) std::cout << "all snapshot checks passed\n";
+  return failures == 0? 0 : 1;
+}